@@ -29,6 +29,12 @@ namespace Exceptions {
         : FileException(fileName, "File not found.") {}
     };
 
+    class NotRegularFileException : public FileException {
+    public:
+        explicit NotRegularFileException(const std::string& fileName)
+            : FileException(fileName, "Not a regular file.") {}
+    };
+
     class FilePermissionException : public FileException {
     public:
         explicit FilePermissionException(const std::string& fileName)
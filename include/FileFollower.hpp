@@ -0,0 +1,60 @@
+#pragma once
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include "Stats.hpp"
+
+struct FollowOptions {
+    std::string checkpointPath = "wordCounter.checkpoint";
+    std::chrono::seconds summaryInterval{5};
+};
+
+// Follows growing files (tail -f style) and counts only the bytes appended since the last read.
+// Offsets, held-back partial tokens and counts are checkpointed so a restart resumes where it stopped.
+class FileFollower {
+public:
+    FileFollower(const std::vector<std::string>& paths, FollowOptions options);
+    ~FileFollower();
+
+    FileFollower(const FileFollower&) = delete;
+    FileFollower& operator=(const FileFollower&) = delete;
+
+    void run(const std::atomic<bool>& stopRequested);
+    void printSummary() const;
+    void saveCheckpoint();
+
+private:
+    struct FollowedFile {
+        WordCountStats stats;
+        int fd = -1;
+        std::uint64_t device = 0;
+        std::uint64_t inode = 0;
+        std::uint64_t offset = 0;
+        std::string pending;
+    };
+
+    void loadCheckpoint();
+    void watchDirectory(const std::string& directory);
+    FollowedFile& track(const std::string& filePath);
+    bool isCheckpointFile(const std::string& filePath) const;
+    void handleEvents();
+    void pollFile(FollowedFile& file);
+    void readAppended(FollowedFile& file);
+    void consume(FollowedFile& file, const char* data, std::size_t size);
+    void flushPending(FollowedFile& file);
+
+    FollowOptions m_options;
+    // Absolute, symlink-resolved checkpoint path so differently spelled paths to it are still recognised.
+    std::string m_resolvedCheckpoint;
+    int m_inotifyFd = -1;
+    std::unordered_map<int, std::string> m_watchedDirectories;
+    std::unordered_set<std::string> m_followedDirectories;
+    std::unordered_map<std::string, FollowedFile> m_files;
+    std::unordered_map<std::string, std::size_t> m_globalWordCount;
+    std::vector<char> m_readBuffer;
+    bool m_dirty = false;
+};
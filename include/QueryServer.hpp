@@ -0,0 +1,84 @@
+#pragma once
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <utility>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include "Stats.hpp"
+
+struct ServeOptions {
+    std::string socketPath = "word_counter.sock";
+};
+
+// Keeps the aggregated word index in memory and answers line-based requests over a Unix socket.
+// Writers build a new immutable snapshot and swap it in, so queries never wait for ingestion.
+//
+// Requests (one per line), responses start with "OK" or "ERR <reason>":
+//   PING                     -> OK
+//   COUNT <word>             -> OK <count>
+//   TOP <k>                  -> OK <rows>, then <rows> lines "<word> <count>"
+//   PREFIX <prefix> [limit]  -> OK <rows>, then <rows> lines "<word> <count>"
+//   FILES                    -> OK <rows>, then <rows> lines "<words> <unique> <bytes> <path>"
+//   FILE <path>              -> OK <words> <unique> <bytes>
+//   STATS                    -> OK <files> <words> <unique>
+//   INGEST <path>[\t<path>...] -> OK <words> <unique>; a path that is already indexed is rejected
+//
+// Each ingest copies the word table (O(V)) and merges its sorted delta into the views, so
+// batching several tab-separated paths into one INGEST amortises that copy.
+class QueryServer {
+public:
+    explicit QueryServer(ServeOptions options);
+    ~QueryServer();
+
+    QueryServer(const QueryServer&) = delete;
+    QueryServer& operator=(const QueryServer&) = delete;
+
+    void ingest(const std::unordered_map<std::string, std::size_t>& wordCount, const std::vector<WordCountStats>& fileStats);
+    // Returns total and unique words of the batch; all files land in one snapshot.
+    std::pair<std::size_t, std::size_t> ingestFiles(const std::vector<std::string>& filePaths);
+    void run(const std::atomic<bool>& stopRequested);
+
+    // A non-empty ingestPath ignores socketPath: the queries go to a scratch server seeded from that
+    // file, which keeps re-ingesting it while they run, so a live index is never modified.
+    static void runLoadTest(const std::string& socketPath, std::size_t connections, std::size_t requestsPerConnection,
+                            const std::string& ingestPath = "");
+
+private:
+    using WordEntry = std::pair<const std::string, std::size_t>;
+
+    struct Snapshot {
+        Snapshot() = default;
+        Snapshot(const Snapshot&) = delete;
+        Snapshot& operator=(const Snapshot&) = delete;
+
+        std::unordered_map<std::string, std::size_t> wordCount;
+        std::unordered_map<std::string, WordCountStats> files;
+        std::vector<const WordEntry*> byCount;
+        std::vector<const WordEntry*> byWord;
+        std::size_t totalWords = 0;
+    };
+
+    struct Connection {
+        int fd = -1;
+        std::thread thread;
+        std::atomic<bool> finished{false};
+    };
+
+    // Counts filePaths into one table and returns their per-file stats.
+    static std::vector<WordCountStats> readFiles(const std::vector<std::string>& filePaths,
+                                                 std::unordered_map<std::string, std::size_t>& wordCount);
+    std::shared_ptr<const Snapshot> snapshot() const;
+    void serveConnection(Connection& connection);
+    std::string handleRequest(const std::string& line);
+    void reapConnections();
+
+    ServeOptions m_options;
+    int m_listenFd = -1;
+    std::mutex m_writerMutex;
+    std::shared_ptr<const Snapshot> m_snapshot;
+    std::list<Connection> m_connections;
+};
@@ -0,0 +1,41 @@
+#pragma once
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <utility>
+
+enum class ExportFormat {
+    Text,
+    Csv,
+    Tsv,
+    Json,
+    Binary
+};
+
+// Exports the vocabulary sorted by descending count. Text output is WordCounter's own report,
+// so only the machine-readable formats are written here.
+//
+// Binary layout (little-endian): "WCNT", u32 version (1), u64 row count,
+// then per row: u32 word length, word bytes (UTF-8), u64 count.
+class ResultExporter {
+public:
+    static ExportFormat parseFormat(const std::string& name);
+    static std::string fileExtension(ExportFormat format);
+    // Writes at most wordLimit rows and returns how many were written.
+    static std::size_t exportWordCounts(const std::unordered_map<std::string, std::size_t>& wordCount,
+                                        const std::string& outputFilePath, ExportFormat format,
+                                        std::size_t wordLimit, std::size_t threadCount);
+
+private:
+    using WordEntry = std::pair<const std::string, std::size_t>;
+
+    // Sort key kept next to the entry so radix passes stream through memory instead of chasing map nodes.
+    struct SortRecord {
+        std::size_t count;
+        const WordEntry* entry;
+    };
+
+    static std::vector<SortRecord> sortByCount(const std::unordered_map<std::string, std::size_t>& wordCount,
+                                               std::size_t threadCount);
+    static void formatRow(std::string& out, const WordEntry& entry, std::size_t rowIndex, ExportFormat format);
+};
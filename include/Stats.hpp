@@ -7,5 +7,8 @@ struct WordCountStats {
     std::string fileName;
     std::size_t totalWords;
     std::size_t uniqueWords;
+    std::size_t lines = 0;
+    std::size_t bytes = 0;
+    std::size_t characters = 0;
     std::chrono::milliseconds processingTime;
 };
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <functional>
 
 namespace Utils {
     bool fileExists(const std::string& filePath);
@@ -11,4 +12,7 @@ namespace Utils {
     bool isLetter(unsigned char c);
     bool isOtherLetter(wchar_t wc);
     bool isUTF8File(const std::string& filePath);
+    void setupUTF8Locale();
+    // Runs task(0..taskCount-1) on up to threadCount threads, the caller included, and rethrows the first failure.
+    void runParallel(std::size_t taskCount, std::size_t threadCount, const std::function<void(std::size_t)>& task);
 }
\ No newline at end of file
@@ -4,22 +4,34 @@
 #include <vector>
 #include <mutex>
 #include <chrono>
+#include <iosfwd>
 #include "Stats.hpp"
+#include "ResultExporter.hpp"
 
 class WordCounter {
 public:
     explicit WordCounter(std::size_t numThreads = 0);
 
     void processFiles(const std::vector<std::string>& filePaths);
-    void saveResultToFile(const std::string& outputFilePath) const;
+    void countFiles(const std::vector<std::string>& filePaths);
+    void saveResultToFile(const std::string& outputFilePath, std::size_t wordLimit = 20) const;
+    void exportResults(const std::string& outputFilePath, ExportFormat format, std::size_t wordLimit) const;
     void printSummary() const;
     std::size_t getThreadCount() const;
     std::size_t getTotalUniqueWords() const;
     std::chrono::milliseconds getTotalProcessingTime() const;
+    const std::unordered_map<std::string, std::size_t>& getWordCounts() const;
+    const std::vector<WordCountStats>& getFileStats() const;
 private:
+    void printCountSummary(std::ostream& out) const;
+
+    static constexpr std::size_t kBatchesPerWorker = 8;
+    static constexpr std::size_t kMaxBatchSize = 256;
+
     std::size_t m_threadCount;
     std::mutex m_mutex;
     std::unordered_map<std::string, std::size_t> m_globalWordCount;
     std::vector<WordCountStats> m_fileStats;
     std::chrono::milliseconds m_totalProcessingTime{0};
+    bool m_countOnly = false;
 };
\ No newline at end of file
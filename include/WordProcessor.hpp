@@ -1,13 +1,29 @@
 #pragma once
+#include <cstddef>
 #include <string>
 #include <unordered_map>
 #include "Stats.hpp"
 
+// Per-word tally shared by all files of a batch; lastFile lets one table report per-file unique counts.
+struct WordTally {
+    std::size_t count = 0;
+    std::size_t lastFile = 0;
+};
+
+using BatchWordCount = std::unordered_map<std::string, WordTally>;
+
 class WordProcessor {
 public:
     static WordCountStats processFile(const std::string& filePath);
+    // Counts into batchCount; fileTag must be non-zero and unique within the batch, buffer is reused between calls.
+    static WordCountStats processFile(const std::string& filePath, BatchWordCount& batchCount,
+                                      std::size_t fileTag, std::string& buffer);
+    // wc-style counting: fills words, lines, bytes and characters without building a dictionary.
+    static WordCountStats countFile(const std::string& filePath);
+    // Adds the cleaned words of text to wordCount and returns how many were added.
+    static std::size_t countWords(const std::string& text, std::unordered_map<std::string, std::size_t>& wordCount);
 
 private:
-    static std::string readFileContents(const std::string& filePath);
-    static std::unordered_map<std::string, std::size_t> countWords(const std::string& text);
+    static void readFileContents(const std::string& filePath, std::string& buffer);
+    static void scanBuffer(const char* data, std::size_t size, WordCountStats& stats, bool& previousIsSpace);
 };
\ No newline at end of file
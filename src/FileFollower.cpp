@@ -0,0 +1,585 @@
+#include "../include/FileFollower.hpp"
+#include "../include/WordProcessor.hpp"
+#include "../include/Exceptions.hpp"
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <iomanip>
+#include <cerrno>
+#include <cstring>
+#include <locale>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    constexpr const char* kCheckpointMagic = "WordCounterCheckpoint";
+    constexpr int kCheckpointVersion = 1;
+    constexpr std::size_t kReadChunkSize = 1 << 20;
+    // A "token" longer than this without whitespace is counted rather than held back forever.
+    constexpr std::size_t kMaxPendingBytes = 1 << 16;
+    constexpr int kMaxPollMilliseconds = 1000;
+
+    bool isAsciiSpace(char c) {
+        return c == ' ' || (c >= '\t' && c <= '\r');
+    }
+
+    // Absolute so the same directory gets one key however it was spelled on the command line.
+    std::string normalizeDirectory(const std::filesystem::path& directory) {
+        std::error_code error;
+        std::filesystem::path absolute = std::filesystem::absolute(directory.empty() ? std::filesystem::path(".") : directory, error);
+        std::filesystem::path normal = (error ? directory : absolute).lexically_normal();
+
+        if (!normal.has_filename() && normal.has_parent_path() && normal != normal.root_path()) {
+            normal = normal.parent_path();
+        }
+
+        return normal.string();
+    }
+
+    std::string joinPath(const std::string& directory, const std::string& name) {
+        return (std::filesystem::path(directory) / name).lexically_normal().string();
+    }
+}
+
+#ifdef __linux__
+
+FileFollower::FileFollower(const std::vector<std::string>& paths, FollowOptions options)
+    : m_options(std::move(options)), m_readBuffer(kReadChunkSize) {
+
+    m_inotifyFd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+    if (m_inotifyFd < 0) {
+        throw Exceptions::WordCounterException(std::string("Unable to initialise inotify: ") + std::strerror(errno));
+    }
+
+    std::error_code error;
+    m_resolvedCheckpoint = std::filesystem::weakly_canonical(std::filesystem::absolute(m_options.checkpointPath), error).string();
+
+    loadCheckpoint();
+
+    std::unordered_set<std::string> requestedFiles;
+
+    for (const auto& path : paths) {
+        std::filesystem::path filePath(path);
+
+        if (std::filesystem::is_directory(filePath)) {
+            std::string directory = normalizeDirectory(filePath);
+            watchDirectory(directory);
+            m_followedDirectories.insert(directory);
+
+            for (const auto& entry : std::filesystem::directory_iterator(filePath)) {
+
+                std::string entryPath = joinPath(directory, entry.path().filename().string());
+
+                if (entry.is_regular_file() && !isCheckpointFile(entryPath)) {
+                    track(entryPath);
+                    requestedFiles.insert(entryPath);
+                }
+            }
+        } else {
+            std::string directory = normalizeDirectory(filePath.parent_path());
+
+            if (!std::filesystem::is_directory(directory)) {
+                throw Exceptions::FileNotFoundException(path);
+            }
+
+            std::string followedPath = joinPath(directory, filePath.filename().string());
+            watchDirectory(directory);
+            track(followedPath);
+            requestedFiles.insert(followedPath);
+        }
+    }
+
+    // Checkpointed files outside the current paths would never get inotify events; stop following them.
+    for (auto it = m_files.begin(); it != m_files.end(); ) {
+        std::string directory = normalizeDirectory(std::filesystem::path(it->first).parent_path());
+
+        bool checkpointFile = isCheckpointFile(it->first);
+
+        if (!checkpointFile && (requestedFiles.count(it->first) || m_followedDirectories.count(directory))) {
+            ++it;
+            continue;
+        }
+
+        std::cerr << "Warning: Dropping checkpointed file " << it->first
+                  << (checkpointFile ? " (it is the checkpoint itself)" : " (not in the followed paths)")
+                  << "; its words stay in the totals." << std::endl;
+
+        if (it->second.fd >= 0) {
+            ::close(it->second.fd);
+        }
+
+        it = m_files.erase(it);
+        m_dirty = true;
+    }
+}
+
+FileFollower::~FileFollower() {
+    for (auto& [path, file] : m_files) {
+
+        if (file.fd >= 0) {
+            ::close(file.fd);
+        }
+    }
+
+    if (m_inotifyFd >= 0) {
+        ::close(m_inotifyFd);
+    }
+}
+
+void FileFollower::run(const std::atomic<bool>& stopRequested) {
+    for (auto& [path, file] : m_files) {
+        pollFile(file);
+    }
+
+    printSummary();
+
+    auto nextSummary = std::chrono::steady_clock::now() + m_options.summaryInterval;
+
+    while (!stopRequested) {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(nextSummary - std::chrono::steady_clock::now());
+        int timeout = static_cast<int>(std::clamp<long long>(remaining.count(), 0, kMaxPollMilliseconds));
+
+        pollfd descriptor{m_inotifyFd, POLLIN, 0};
+        int ready = ::poll(&descriptor, 1, timeout);
+
+        if (ready < 0 && errno != EINTR) {
+            throw Exceptions::WordCounterException(std::string("inotify poll failed: ") + std::strerror(errno));
+        }
+
+        if (ready > 0) {
+            handleEvents();
+        }
+
+        if (std::chrono::steady_clock::now() >= nextSummary) {
+            printSummary();
+
+            try {
+                saveCheckpoint();
+            } catch (const Exceptions::OutputException& e) {
+                std::cerr << "Warning: " << e.what() << std::endl;
+            }
+
+            nextSummary = std::chrono::steady_clock::now() + m_options.summaryInterval;
+        }
+    }
+
+    saveCheckpoint();
+}
+
+void FileFollower::watchDirectory(const std::string& directory) {
+    int watch = ::inotify_add_watch(m_inotifyFd, directory.c_str(),
+                                    IN_MODIFY | IN_CREATE | IN_MOVED_TO | IN_CLOSE_WRITE);
+
+    if (watch < 0) {
+        throw Exceptions::FileProcessingException(directory, std::string("Unable to watch directory: ") + std::strerror(errno));
+    }
+
+    m_watchedDirectories.emplace(watch, directory);
+}
+
+FileFollower::FollowedFile& FileFollower::track(const std::string& filePath) {
+    auto [it, inserted] = m_files.try_emplace(filePath);
+
+    FollowedFile& file = it->second;
+
+    if (!inserted) {
+        return file;
+    }
+
+    file.stats.fileName = filePath;
+    file.stats.totalWords = 0;
+    file.stats.uniqueWords = 0;
+    file.stats.processingTime = std::chrono::milliseconds{0};
+
+    // A new name for a file we already follow (e.g. app.log renamed to app.log.1 by rotation)
+    // takes over its read position so the content is not counted twice.
+    struct stat pathStat{};
+
+    if (::stat(filePath.c_str(), &pathStat) != 0) {
+        return file;
+    }
+
+    for (auto& [otherPath, other] : m_files) {
+
+        if (&other != &file && other.inode != 0 &&
+            other.device == static_cast<std::uint64_t>(pathStat.st_dev) &&
+            other.inode == static_cast<std::uint64_t>(pathStat.st_ino)) {
+            file.fd = other.fd;
+            file.device = other.device;
+            file.inode = other.inode;
+            file.offset = other.offset;
+            file.pending = std::move(other.pending);
+
+            other.fd = -1;
+            other.device = 0;
+            other.inode = 0;
+            other.offset = 0;
+            other.pending.clear();
+            m_dirty = true;
+            break;
+        }
+    }
+
+    return file;
+}
+
+bool FileFollower::isCheckpointFile(const std::string& filePath) const {
+    std::error_code error;
+    std::string resolved = std::filesystem::weakly_canonical(std::filesystem::absolute(filePath), error).string();
+
+    return !error && (resolved == m_resolvedCheckpoint || resolved == m_resolvedCheckpoint + ".tmp");
+}
+
+void FileFollower::handleEvents() {
+    alignas(inotify_event) char buffer[64 * 1024];
+
+    while (true) {
+        ssize_t length = ::read(m_inotifyFd, buffer, sizeof(buffer));
+
+        if (length < 0) {
+
+            if (errno == EINTR) {
+                continue;
+            }
+
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+
+            throw Exceptions::WordCounterException(std::string("inotify read failed: ") + std::strerror(errno));
+        }
+
+        for (char* cursor = buffer; cursor < buffer + length; ) {
+            const auto* event = reinterpret_cast<const inotify_event*>(cursor);
+            cursor += sizeof(inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+
+                for (auto& [path, file] : m_files) {
+                    pollFile(file);
+                }
+
+                continue;
+            }
+
+            auto directory = m_watchedDirectories.find(event->wd);
+
+            if (event->len == 0 || directory == m_watchedDirectories.end()) {
+                continue;
+            }
+
+            std::string filePath = joinPath(directory->second, event->name);
+            auto file = m_files.find(filePath);
+
+            if (file != m_files.end()) {
+                pollFile(file->second);
+            } else if (m_followedDirectories.count(directory->second) && !isCheckpointFile(filePath) &&
+                       std::filesystem::is_regular_file(filePath)) {
+                pollFile(track(filePath));
+            }
+        }
+    }
+}
+
+void FileFollower::pollFile(FollowedFile& file) {
+    const std::string& filePath = file.stats.fileName;
+    struct stat pathStat{};
+    bool onDisk = ::stat(filePath.c_str(), &pathStat) == 0 && S_ISREG(pathStat.st_mode);
+
+    // Rotated: finish the old file through the descriptor we still hold, then switch to the new one.
+    if (file.fd >= 0 && onDisk &&
+        (static_cast<std::uint64_t>(pathStat.st_dev) != file.device ||
+         static_cast<std::uint64_t>(pathStat.st_ino) != file.inode)) {
+        readAppended(file);
+        flushPending(file);
+        ::close(file.fd);
+        file.fd = -1;
+        file.device = 0;
+        file.inode = 0;
+        file.offset = 0;
+        std::cerr << "Rotation detected: " << filePath << std::endl;
+    }
+
+    if (file.fd < 0) {
+
+        if (!onDisk) {
+            return;
+        }
+
+        int fd = ::open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+
+        if (fd < 0) {
+            std::cerr << "Unable to open " << filePath << ": " << std::strerror(errno) << std::endl;
+            return;
+        }
+
+        struct stat fdStat{};
+        ::fstat(fd, &fdStat);
+
+        // A different file than the checkpoint describes was rotated in while we were not running.
+        if (static_cast<std::uint64_t>(fdStat.st_dev) != file.device ||
+            static_cast<std::uint64_t>(fdStat.st_ino) != file.inode) {
+
+            if (file.inode != 0) {
+                std::cerr << "Rotation detected: " << filePath << std::endl;
+            }
+
+            flushPending(file);
+            file.offset = 0;
+        }
+
+        file.fd = fd;
+        file.device = static_cast<std::uint64_t>(fdStat.st_dev);
+        file.inode = static_cast<std::uint64_t>(fdStat.st_ino);
+        m_dirty = true;
+    }
+
+    struct stat fdStat{};
+
+    if (::fstat(file.fd, &fdStat) == 0 && static_cast<std::uint64_t>(fdStat.st_size) < file.offset) {
+        std::cerr << "Truncation detected: " << filePath << std::endl;
+        flushPending(file);
+        file.offset = 0;
+        m_dirty = true;
+    }
+
+    readAppended(file);
+}
+
+void FileFollower::readAppended(FollowedFile& file) {
+    while (true) {
+        ssize_t bytesRead = ::pread(file.fd, m_readBuffer.data(), m_readBuffer.size(), static_cast<off_t>(file.offset));
+
+        if (bytesRead < 0) {
+
+            if (errno == EINTR) {
+                continue;
+            }
+
+            std::cerr << "Read failed for " << file.stats.fileName << ": " << std::strerror(errno) << std::endl;
+            return;
+        }
+
+        if (bytesRead == 0) {
+            return;
+        }
+
+        consume(file, m_readBuffer.data(), static_cast<std::size_t>(bytesRead));
+        file.offset += static_cast<std::uint64_t>(bytesRead);
+        m_dirty = true;
+    }
+}
+
+#else
+
+FileFollower::FileFollower(const std::vector<std::string>&, FollowOptions options)
+    : m_options(std::move(options)) {
+    throw Exceptions::WordCounterException("Follow mode requires inotify and is only supported on Linux.");
+}
+
+FileFollower::~FileFollower() = default;
+
+void FileFollower::run(const std::atomic<bool>&) {}
+void FileFollower::watchDirectory(const std::string&) {}
+void FileFollower::handleEvents() {}
+void FileFollower::pollFile(FollowedFile&) {}
+void FileFollower::readAppended(FollowedFile&) {}
+
+FileFollower::FollowedFile& FileFollower::track(const std::string& filePath) {
+    return m_files[filePath];
+}
+
+bool FileFollower::isCheckpointFile(const std::string&) const {
+    return false;
+}
+
+#endif
+
+void FileFollower::consume(FollowedFile& file, const char* data, std::size_t size) {
+    if (file.offset == 0 && size >= 3 &&
+        static_cast<unsigned char>(data[0]) == 0xEF &&
+        static_cast<unsigned char>(data[1]) == 0xBB &&
+        static_cast<unsigned char>(data[2]) == 0xBF) {
+        data += 3;
+        size -= 3;
+    }
+
+    file.stats.bytes += size;
+    file.stats.lines += static_cast<std::size_t>(std::count(data, data + size, '\n'));
+    file.pending.append(data, size);
+
+    // Only text up to the last whitespace is complete; the rest may continue in the next write.
+    std::size_t complete = file.pending.size();
+
+    while (complete > 0 && !isAsciiSpace(file.pending[complete - 1])) {
+        complete--;
+    }
+
+    if (complete == 0) {
+
+        if (file.pending.size() > kMaxPendingBytes) {
+            flushPending(file);
+        }
+
+        return;
+    }
+
+    std::string text = file.pending.substr(0, complete);
+    file.pending.erase(0, complete);
+    file.stats.totalWords += WordProcessor::countWords(text, m_globalWordCount);
+}
+
+void FileFollower::flushPending(FollowedFile& file) {
+    if (file.pending.empty()) {
+        return;
+    }
+
+    file.stats.totalWords += WordProcessor::countWords(file.pending, m_globalWordCount);
+    file.pending.clear();
+    m_dirty = true;
+}
+
+void FileFollower::printSummary() const {
+    std::size_t totalWords = 0;
+
+    for (const auto& [path, file] : m_files) {
+        totalWords += file.stats.totalWords;
+    }
+
+    std::cout << "Follow Summary\n";
+    std::cout << "===================\n";
+    std::cout << "Files Followed: " << m_files.size() << "\n";
+    std::cout << "Total Words: " << totalWords << "\n";
+    std::cout << "Total Unique Words: " << m_globalWordCount.size() << "\n\n";
+
+    for (const auto& [path, file] : m_files) {
+        std::cout << "File: " << file.stats.fileName << "\n";
+        std::cout << "Total Words: " << file.stats.totalWords << "\n";
+        std::cout << "Lines: " << file.stats.lines << "\n";
+        std::cout << "Bytes: " << file.stats.bytes << "\n\n";
+    }
+
+    std::cout << "5 most frequent words:\n";
+    std::vector<std::pair<std::string, std::size_t>> wordFrequency(m_globalWordCount.begin(), m_globalWordCount.end());
+    auto topEnd = wordFrequency.begin() + std::min<std::size_t>(5, wordFrequency.size());
+    std::partial_sort(wordFrequency.begin(), topEnd, wordFrequency.end(),
+                      [](const auto& a, const auto& b) { return a.second > b.second; });
+
+    for (auto it = wordFrequency.begin(); it != topEnd; ++it) {
+        std::cout << std::setw(15) << std::left << it->first << ": " << it->second << "\n";
+    }
+
+    std::cout << std::endl;
+}
+
+void FileFollower::saveCheckpoint() {
+    if (!m_dirty) {
+        return;
+    }
+
+    std::string temporaryPath = m_options.checkpointPath + ".tmp";
+    std::ofstream out(temporaryPath, std::ios::binary | std::ios::trunc);
+    out.imbue(std::locale::classic());
+
+    if (!out) {
+        throw Exceptions::OutputException(temporaryPath, "Unable to open checkpoint file.");
+    }
+
+    out << kCheckpointMagic << " " << kCheckpointVersion << "\n";
+
+    for (const auto& [path, file] : m_files) {
+        out << "file " << file.device << " " << file.inode << " " << file.offset << " "
+            << file.stats.totalWords << " " << file.stats.lines << " " << file.stats.bytes << " "
+            << file.pending.size() << " " << path.size() << "\n"
+            << file.pending << path << "\n";
+    }
+
+    for (const auto& [word, count] : m_globalWordCount) {
+        out << "word " << count << " " << word << "\n";
+    }
+
+    out.close();
+
+    if (!out) {
+        throw Exceptions::OutputException(temporaryPath, "Unable to write checkpoint file.");
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporaryPath, m_options.checkpointPath, error);
+
+    if (error) {
+        throw Exceptions::OutputException(m_options.checkpointPath, error.message());
+    }
+
+    m_dirty = false;
+}
+
+void FileFollower::loadCheckpoint() {
+    std::ifstream in(m_options.checkpointPath, std::ios::binary);
+    in.imbue(std::locale::classic());
+
+    if (!in) {
+        return;
+    }
+
+    std::string magic;
+    int version = 0;
+
+    if (!(in >> magic >> version) || magic != kCheckpointMagic || version != kCheckpointVersion) {
+        throw Exceptions::InvalidFileFormatException(m_options.checkpointPath, "unrecognised checkpoint header");
+    }
+
+    std::string kind;
+
+    while (in >> kind) {
+
+        if (kind == "file") {
+            FollowedFile file;
+            std::size_t pendingSize = 0;
+            std::size_t pathSize = 0;
+
+            in >> file.device >> file.inode >> file.offset
+               >> file.stats.totalWords >> file.stats.lines >> file.stats.bytes
+               >> pendingSize >> pathSize;
+            in.get();
+
+            file.pending.resize(pendingSize);
+            file.stats.fileName.resize(pathSize);
+            in.read(file.pending.data(), static_cast<std::streamsize>(pendingSize));
+            in.read(file.stats.fileName.data(), static_cast<std::streamsize>(pathSize));
+            file.stats.uniqueWords = 0;
+            file.stats.processingTime = std::chrono::milliseconds{0};
+
+            if (!in) {
+                break;
+            }
+
+            std::string path = file.stats.fileName;
+            m_files[path] = std::move(file);
+        } else if (kind == "word") {
+            std::size_t count = 0;
+            std::string word;
+
+            if (in >> count >> word) {
+                m_globalWordCount[word] = count;
+            }
+        } else {
+            throw Exceptions::InvalidFileFormatException(m_options.checkpointPath, "unknown checkpoint record '" + kind + "'");
+        }
+    }
+
+    if (!in.eof()) {
+        throw Exceptions::InvalidFileFormatException(m_options.checkpointPath, "truncated checkpoint");
+    }
+
+    std::cerr << "Resumed from checkpoint " << m_options.checkpointPath << ": "
+              << m_files.size() << " files, " << m_globalWordCount.size() << " unique words" << std::endl;
+}
@@ -0,0 +1,690 @@
+#include "../include/QueryServer.hpp"
+#include "../include/WordProcessor.hpp"
+#include "../include/Exceptions.hpp"
+#include "../include/Utils.hpp"
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <filesystem>
+#include <iterator>
+#include <cerrno>
+#include <cstring>
+#include <locale>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    constexpr int kMaxPollMilliseconds = 1000;
+    constexpr std::size_t kDefaultTopK = 10;
+    constexpr std::size_t kDefaultPrefixLimit = 100;
+    constexpr std::size_t kMaxLineLength = 1 << 16;
+
+    std::string errorResponse(const std::string& reason) {
+        return "ERR " + reason + "\n";
+    }
+
+    double percentile(const std::vector<double>& sorted, double p) {
+        return sorted[std::min(sorted.size() - 1, static_cast<std::size_t>(p * static_cast<double>(sorted.size())))];
+    }
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+
+namespace {
+    sockaddr_un socketAddress(const std::string& socketPath) {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+
+        if (socketPath.empty() || socketPath.size() >= sizeof(address.sun_path)) {
+            throw Exceptions::InvalidArgumentException(socketPath, "Socket path is empty or too long.");
+        }
+
+        std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+        return address;
+    }
+
+    // Connected client socket, or -1 with errno set.
+    int connectSocket(const sockaddr_un& address) {
+        int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+
+        if (fd >= 0 && ::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) < 0) {
+            int savedErrno = errno;
+            ::close(fd);
+            errno = savedErrno;
+            return -1;
+        }
+
+        return fd;
+    }
+
+    bool writeAll(int fd, const std::string& data) {
+        std::size_t written = 0;
+
+        while (written < data.size()) {
+            ssize_t result = ::write(fd, data.data() + written, data.size() - written);
+
+            if (result < 0) {
+
+                if (errno == EINTR) {
+                    continue;
+                }
+
+                return false;
+            }
+
+            written += static_cast<std::size_t>(result);
+        }
+
+        return true;
+    }
+
+    // Buffered line reader over a socket; returns false on EOF or error.
+    class LineReader {
+    public:
+        explicit LineReader(int fd) : m_fd(fd) {}
+
+        bool readLine(std::string& line) {
+            while (true) {
+                std::size_t newline = m_buffer.find('\n', m_scanned);
+
+                if (newline != std::string::npos) {
+                    line.assign(m_buffer, 0, newline);
+                    m_buffer.erase(0, newline + 1);
+                    m_scanned = 0;
+
+                    if (!line.empty() && line.back() == '\r') {
+                        line.pop_back();
+                    }
+
+                    return true;
+                }
+
+                if (m_buffer.size() > kMaxLineLength) {
+                    return false;
+                }
+
+                m_scanned = m_buffer.size();
+                char chunk[4096];
+                ssize_t result = ::read(m_fd, chunk, sizeof(chunk));
+
+                if (result < 0 && errno == EINTR) {
+                    continue;
+                }
+
+                if (result <= 0) {
+                    return false;
+                }
+
+                m_buffer.append(chunk, static_cast<std::size_t>(result));
+            }
+        }
+
+    private:
+        int m_fd;
+        std::string m_buffer;
+        std::size_t m_scanned = 0;
+    };
+}
+
+QueryServer::QueryServer(ServeOptions options)
+    : m_options(std::move(options)), m_snapshot(std::make_shared<const Snapshot>()) {
+
+    sockaddr_un address = socketAddress(m_options.socketPath);
+    m_listenFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if (m_listenFd < 0) {
+        throw Exceptions::WordCounterException(std::string("Unable to create socket: ") + std::strerror(errno));
+    }
+
+    // Only a stale socket is replaced; a live server or any other kind of file is left alone.
+    struct stat pathStat{};
+
+    if (::lstat(m_options.socketPath.c_str(), &pathStat) == 0) {
+        std::string reason;
+
+        if (!S_ISSOCK(pathStat.st_mode)) {
+            reason = "Path exists and is not a socket.";
+        } else {
+            int probeFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+
+            if (probeFd >= 0 && ::connect(probeFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0) {
+                reason = "Another server is already listening on this socket.";
+            }
+
+            if (probeFd >= 0) {
+                ::close(probeFd);
+            }
+        }
+
+        if (!reason.empty()) {
+            ::close(m_listenFd);
+            m_listenFd = -1;
+            throw Exceptions::OutputException(m_options.socketPath, reason);
+        }
+
+        ::unlink(m_options.socketPath.c_str());
+    }
+
+    if (::bind(m_listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+        ::listen(m_listenFd, SOMAXCONN) < 0) {
+        std::string reason = std::strerror(errno);
+        ::close(m_listenFd);
+        m_listenFd = -1;
+        throw Exceptions::WordCounterException("Unable to listen on " + m_options.socketPath + ": " + reason);
+    }
+}
+
+QueryServer::~QueryServer() {
+    for (auto& connection : m_connections) {
+        ::shutdown(connection.fd, SHUT_RDWR);
+    }
+
+    for (auto& connection : m_connections) {
+
+        if (connection.thread.joinable()) {
+            connection.thread.join();
+        }
+
+        ::close(connection.fd);
+    }
+
+    if (m_listenFd >= 0) {
+        ::close(m_listenFd);
+        ::unlink(m_options.socketPath.c_str());
+    }
+}
+
+void QueryServer::run(const std::atomic<bool>& stopRequested) {
+    std::cout << "Serving " << snapshot()->wordCount.size() << " unique words on "
+              << m_options.socketPath << std::endl;
+
+    while (!stopRequested) {
+        pollfd descriptor{m_listenFd, POLLIN, 0};
+        int ready = ::poll(&descriptor, 1, kMaxPollMilliseconds);
+
+        if (ready < 0 && errno != EINTR) {
+            throw Exceptions::WordCounterException(std::string("Socket poll failed: ") + std::strerror(errno));
+        }
+
+        reapConnections();
+
+        if (ready <= 0) {
+            continue;
+        }
+
+        int clientFd = ::accept(m_listenFd, nullptr, nullptr);
+
+        if (clientFd < 0) {
+            continue;
+        }
+
+        Connection& connection = m_connections.emplace_back();
+        connection.fd = clientFd;
+
+        try {
+            connection.thread = std::thread(&QueryServer::serveConnection, this, std::ref(connection));
+        } catch (const std::system_error& e) {
+            ::close(clientFd);
+            m_connections.pop_back();
+            std::cerr << "Warning: " << Exceptions::ThreadException(e.what()).what() << std::endl;
+        }
+    }
+}
+
+void QueryServer::reapConnections() {
+    for (auto it = m_connections.begin(); it != m_connections.end(); ) {
+
+        if (it->finished) {
+            it->thread.join();
+            ::close(it->fd);
+            it = m_connections.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void QueryServer::serveConnection(Connection& connection) {
+    LineReader reader(connection.fd);
+    std::string line;
+
+    while (reader.readLine(line)) {
+
+        if (!writeAll(connection.fd, handleRequest(line))) {
+            break;
+        }
+    }
+
+    connection.finished = true;
+}
+
+void QueryServer::runLoadTest(const std::string& socketPath, std::size_t connections, std::size_t requestsPerConnection,
+                              const std::string& ingestPath) {
+    const std::vector<std::pair<std::string, bool>> requests = {
+        {"COUNT the", false}, {"TOP 10", true}, {"PREFIX th 10", true}, {"STATS", false}
+    };
+
+    sockaddr_un address = socketAddress(socketPath);
+    connections = std::max<std::size_t>(connections, 1);
+    std::vector<std::vector<double>> latencies(connections);
+    std::vector<std::string> errors(connections);
+    std::vector<std::thread> clients;
+
+    // With an ingest file the live index is never touched: the test serves a scratch index seeded
+    // from that file on a temporary socket and re-ingests it in-process while the queries run.
+    std::vector<double> ingestLatencies;
+    std::exception_ptr scratchFailure;
+    std::exception_ptr writerFailure;
+    std::atomic<bool> readersDone{false};
+    std::atomic<bool> stopScratch{false};
+    std::unique_ptr<QueryServer> scratch;
+    std::thread scratchThread;
+    std::thread writer;
+    std::filesystem::path scratchDirectory;
+
+    if (!ingestPath.empty()) {
+        std::unordered_map<std::string, std::size_t> wordCount;
+        std::vector<WordCountStats> fileStats = readFiles({ingestPath}, wordCount);
+
+        std::error_code error;
+        scratchDirectory = std::filesystem::temp_directory_path(error) / ("word_counter_loadtest_" + std::to_string(::getpid()));
+
+        if (!std::filesystem::create_directories(scratchDirectory, error) && error) {
+            throw Exceptions::OutputException(scratchDirectory.string(), "Unable to create directory: " + error.message());
+        }
+
+        ServeOptions options;
+        options.socketPath = (scratchDirectory / "loadtest.sock").string();
+        address = socketAddress(options.socketPath);
+        scratch = std::make_unique<QueryServer>(options);
+        scratch->ingest(wordCount, fileStats);
+
+        scratchThread = std::thread([&]() {
+            try {
+                scratch->run(stopScratch);
+            } catch (...) {
+                scratchFailure = std::current_exception();
+            }
+        });
+
+        writer = std::thread([&, wordCount = std::move(wordCount), fileStats]() mutable {
+            try {
+                for (std::size_t i = 1; !readersDone; ++i) {
+                    fileStats.front().fileName = ingestPath + "#" + std::to_string(i);
+                    auto started = std::chrono::steady_clock::now();
+                    scratch->ingest(wordCount, fileStats);
+                    auto finished = std::chrono::steady_clock::now();
+                    ingestLatencies.push_back(std::chrono::duration<double, std::micro>(finished - started).count());
+                }
+            } catch (...) {
+                writerFailure = std::current_exception();
+            }
+        });
+    }
+
+    auto startTime = std::chrono::steady_clock::now();
+
+    for (std::size_t c = 0; c < connections; ++c) {
+        clients.emplace_back([&, c]() {
+            int fd = connectSocket(address);
+
+            if (fd < 0) {
+                errors[c] = std::strerror(errno);
+                return;
+            }
+
+            LineReader reader(fd);
+            std::string line;
+            latencies[c].reserve(requestsPerConnection);
+
+            for (std::size_t i = 0; i < requestsPerConnection; ++i) {
+                const auto& [request, multiRow] = requests[(i + c) % requests.size()];
+                auto sent = std::chrono::steady_clock::now();
+
+                if (!writeAll(fd, request + "\n") || !reader.readLine(line)) {
+                    errors[c] = "connection closed by server";
+                    break;
+                }
+
+                if (multiRow && line.compare(0, 3, "OK ") == 0) {
+                    std::size_t rows = std::stoul(line.substr(3));
+
+                    for (std::size_t row = 0; row < rows && reader.readLine(line); ++row) {
+                    }
+                }
+
+                auto received = std::chrono::steady_clock::now();
+                latencies[c].push_back(std::chrono::duration<double, std::micro>(received - sent).count());
+            }
+
+            ::close(fd);
+        });
+    }
+
+    for (auto& client : clients) {
+        client.join();
+    }
+
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    readersDone = true;
+
+    if (scratch) {
+        writer.join();
+        stopScratch = true;
+        scratchThread.join();
+        scratch.reset();
+        std::error_code error;
+        std::filesystem::remove_all(scratchDirectory, error);
+    }
+
+    for (const auto& failure : {scratchFailure, writerFailure}) {
+
+        if (failure) {
+            std::rethrow_exception(failure);
+        }
+    }
+
+    for (const auto& error : errors) {
+
+        if (!error.empty()) {
+            throw Exceptions::WordCounterException("Load test failed: " + error);
+        }
+    }
+
+    std::vector<double> all;
+
+    for (const auto& samples : latencies) {
+        all.insert(all.end(), samples.begin(), samples.end());
+    }
+
+    if (all.empty()) {
+        std::cout << "No requests completed." << std::endl;
+        return;
+    }
+
+    std::sort(all.begin(), all.end());
+    std::sort(ingestLatencies.begin(), ingestLatencies.end());
+
+    std::cout << "Load Test Summary\n";
+    std::cout << "===================\n";
+    std::cout << "Connections: " << connections << "\n";
+    std::cout << "Requests: " << all.size() << "\n";
+    std::cout << "Throughput: " << static_cast<std::size_t>(static_cast<double>(all.size()) / elapsed) << " requests/s\n";
+    std::cout << "p50 latency: " << percentile(all, 0.50) << " us\n";
+    std::cout << "p99 latency: " << percentile(all, 0.99) << " us\n";
+    std::cout << "max latency: " << all.back() << " us\n";
+
+    if (!ingestPath.empty()) {
+        std::cout << "Concurrent ingests (scratch index): " << ingestLatencies.size() << "\n";
+
+        if (!ingestLatencies.empty()) {
+            std::cout << "Ingest p50 latency: " << percentile(ingestLatencies, 0.50) << " us\n";
+            std::cout << "Ingest max latency: " << ingestLatencies.back() << " us\n";
+        }
+    }
+
+    std::cout << std::flush;
+}
+
+#else
+
+QueryServer::QueryServer(ServeOptions options)
+    : m_options(std::move(options)), m_snapshot(std::make_shared<const Snapshot>()) {
+    throw Exceptions::WordCounterException("Serve mode requires Unix domain sockets and is not supported on this platform.");
+}
+
+QueryServer::~QueryServer() = default;
+
+void QueryServer::run(const std::atomic<bool>&) {}
+void QueryServer::reapConnections() {}
+void QueryServer::serveConnection(Connection&) {}
+
+void QueryServer::runLoadTest(const std::string&, std::size_t, std::size_t, const std::string&) {
+    throw Exceptions::WordCounterException("Load test requires Unix domain sockets and is not supported on this platform.");
+}
+
+#endif
+
+std::shared_ptr<const QueryServer::Snapshot> QueryServer::snapshot() const {
+    return std::atomic_load(&m_snapshot);
+}
+
+void QueryServer::ingest(const std::unordered_map<std::string, std::size_t>& wordCount, const std::vector<WordCountStats>& fileStats) {
+    std::lock_guard<std::mutex> lock(m_writerMutex);
+
+    // Readers keep using the current snapshot while the next one is built from a copy.
+    auto current = snapshot();
+
+    // Only totals are kept per file, so a second ingest could not replace the first one's words.
+    for (std::size_t i = 0; i < fileStats.size(); ++i) {
+        const std::string& fileName = fileStats[i].fileName;
+
+        if (current->files.count(fileName) ||
+            std::any_of(fileStats.begin(), fileStats.begin() + i,
+                        [&fileName](const WordCountStats& other) { return other.fileName == fileName; })) {
+            throw Exceptions::InvalidArgumentException(fileName, "File is already indexed.");
+        }
+    }
+
+    auto next = std::make_shared<Snapshot>();
+    next->wordCount = current->wordCount;
+    next->files = current->files;
+    next->totalWords = current->totalWords;
+
+    std::vector<const WordEntry*> changed;
+    std::vector<const WordEntry*> added;
+    changed.reserve(wordCount.size());
+
+    for (const auto& [word, count] : wordCount) {
+        auto [it, inserted] = next->wordCount.try_emplace(word, 0);
+        it->second += count;
+        next->totalWords += count;
+        changed.push_back(&*it);
+
+        if (inserted) {
+            added.push_back(&*it);
+        }
+    }
+
+    for (const auto& stats : fileStats) {
+        next->files[stats.fileName] = stats;
+    }
+
+    // Merge the sorted delta into the previous views instead of re-sorting the whole vocabulary:
+    // O(V) to carry the old order across plus O(D log D) for the D words this ingest touched.
+    auto byCountOrder = [](const WordEntry* a, const WordEntry* b) {
+        return a->second != b->second ? a->second > b->second : a->first < b->first;
+    };
+    auto byWordOrder = [](const WordEntry* a, const WordEntry* b) {
+        return a->first < b->first;
+    };
+    auto carried = [&next](const WordEntry* entry) {
+        return &*next->wordCount.find(entry->first);
+    };
+
+    std::sort(changed.begin(), changed.end(), byCountOrder);
+    std::sort(added.begin(), added.end(), byWordOrder);
+
+    std::vector<const WordEntry*> unchanged;
+    unchanged.reserve(current->byCount.size());
+
+    for (const auto* entry : current->byCount) {
+
+        if (!wordCount.count(entry->first)) {
+            unchanged.push_back(carried(entry));
+        }
+    }
+
+    next->byCount.reserve(next->wordCount.size());
+    std::merge(unchanged.begin(), unchanged.end(), changed.begin(), changed.end(),
+               std::back_inserter(next->byCount), byCountOrder);
+
+    unchanged.clear();
+
+    for (const auto* entry : current->byWord) {
+        unchanged.push_back(carried(entry));
+    }
+
+    next->byWord.reserve(next->wordCount.size());
+    std::merge(unchanged.begin(), unchanged.end(), added.begin(), added.end(),
+               std::back_inserter(next->byWord), byWordOrder);
+
+    std::atomic_store(&m_snapshot, std::shared_ptr<const Snapshot>(std::move(next)));
+}
+
+std::vector<WordCountStats> QueryServer::readFiles(const std::vector<std::string>& filePaths,
+                                                   std::unordered_map<std::string, std::size_t>& wordCount) {
+    BatchWordCount batchCount;
+    std::string buffer;
+    std::vector<WordCountStats> fileStats;
+
+    for (std::size_t i = 0; i < filePaths.size(); ++i) {
+        fileStats.push_back(WordProcessor::processFile(filePaths[i], batchCount, i + 1, buffer));
+    }
+
+    wordCount.reserve(batchCount.size());
+
+    for (auto& [word, tally] : batchCount) {
+        wordCount.emplace(word, tally.count);
+    }
+
+    return fileStats;
+}
+
+std::pair<std::size_t, std::size_t> QueryServer::ingestFiles(const std::vector<std::string>& filePaths) {
+    auto current = snapshot();
+
+    for (const auto& filePath : filePaths) {
+
+        if (current->files.count(filePath)) {
+            throw Exceptions::InvalidArgumentException(filePath, "File is already indexed.");
+        }
+    }
+
+    std::unordered_map<std::string, std::size_t> wordCount;
+    auto fileStats = readFiles(filePaths, wordCount);
+    std::size_t totalWords = 0;
+
+    for (const auto& stats : fileStats) {
+        totalWords += stats.totalWords;
+    }
+
+    ingest(wordCount, fileStats);
+    return {totalWords, wordCount.size()};
+}
+
+std::string QueryServer::handleRequest(const std::string& line) {
+    std::size_t space = line.find(' ');
+    std::string command = line.substr(0, space);
+    std::string argument = space == std::string::npos ? std::string() : line.substr(space + 1);
+    std::ostringstream response;
+    response.imbue(std::locale::classic());
+
+    try {
+        if (command == "PING") {
+            return "OK\n";
+        }
+
+        if (command == "INGEST") {
+
+            std::vector<std::string> filePaths;
+            std::istringstream paths(argument);
+
+            for (std::string path; std::getline(paths, path, '\t'); ) {
+
+                if (!path.empty()) {
+                    filePaths.push_back(path);
+                }
+            }
+
+            if (filePaths.empty()) {
+                return errorResponse("INGEST requires a file path");
+            }
+
+            auto [totalWords, uniqueWords] = ingestFiles(filePaths);
+            response << "OK " << totalWords << " " << uniqueWords << "\n";
+            return response.str();
+        }
+
+        auto current = snapshot();
+
+        if (command == "COUNT") {
+            auto it = current->wordCount.find(Utils::cleanWord(argument));
+            response << "OK " << (it == current->wordCount.end() ? 0 : it->second) << "\n";
+        } else if (command == "TOP") {
+            std::size_t k = argument.empty() ? kDefaultTopK : std::stoul(argument);
+            std::size_t rows = std::min(k, current->byCount.size());
+            response << "OK " << rows << "\n";
+
+            for (std::size_t i = 0; i < rows; ++i) {
+                response << current->byCount[i]->first << " " << current->byCount[i]->second << "\n";
+            }
+        } else if (command == "PREFIX") {
+            std::istringstream arguments(argument);
+            arguments.imbue(std::locale::classic());
+            std::string prefix;
+            std::string limitText;
+            std::size_t limit = kDefaultPrefixLimit;
+            arguments >> prefix >> limitText;
+
+            if (!limitText.empty()) {
+                // Digits only: the stream would accept "-1" as a huge unsigned value.
+                std::istringstream limitStream(limitText);
+                limitStream.imbue(std::locale::classic());
+
+                if (limitText.find_first_not_of("0123456789") != std::string::npos || !(limitStream >> limit)) {
+                    return errorResponse("invalid limit");
+                }
+            }
+
+            prefix = Utils::cleanWord(prefix);
+
+            auto first = std::lower_bound(current->byWord.begin(), current->byWord.end(), prefix,
+                                          [](const WordEntry* entry, const std::string& value) { return entry->first < value; });
+            std::vector<const WordEntry*> matches;
+
+            for (auto it = first; it != current->byWord.end() && matches.size() < limit &&
+                                  (*it)->first.compare(0, prefix.size(), prefix) == 0; ++it) {
+                matches.push_back(*it);
+            }
+
+            response << "OK " << matches.size() << "\n";
+
+            for (const auto* entry : matches) {
+                response << entry->first << " " << entry->second << "\n";
+            }
+        } else if (command == "FILES") {
+            response << "OK " << current->files.size() << "\n";
+
+            for (const auto& [path, stats] : current->files) {
+                response << stats.totalWords << " " << stats.uniqueWords << " " << stats.bytes << " " << path << "\n";
+            }
+        } else if (command == "FILE") {
+            auto it = current->files.find(argument);
+
+            if (it == current->files.end()) {
+                return errorResponse("unknown file " + argument);
+            }
+
+            response << "OK " << it->second.totalWords << " " << it->second.uniqueWords << " " << it->second.bytes << "\n";
+        } else if (command == "STATS") {
+            response << "OK " << current->files.size() << " " << current->totalWords << " " << current->wordCount.size() << "\n";
+        } else {
+            return errorResponse("unknown command " + command);
+        }
+    } catch (const Exceptions::WordCounterException& e) {
+        return errorResponse(e.what());
+    } catch (const std::exception& e) {
+        return errorResponse(std::string("invalid argument: ") + e.what());
+    }
+
+    return response.str();
+}
@@ -0,0 +1,353 @@
+#include "../include/ResultExporter.hpp"
+#include "../include/Exceptions.hpp"
+#include "../include/Utils.hpp"
+#include <fstream>
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstdint>
+
+namespace {
+    constexpr std::size_t kMinRowsPerThread = 1 << 15;
+    constexpr std::size_t kRowsPerBlock = 1 << 16;
+    constexpr int kRadixBits = 8;
+    constexpr std::size_t kRadixBuckets = 1 << kRadixBits;
+    // Sorted rows point at map nodes in effectively random order; fetch a few rows ahead.
+    // Only the node is prefetched: reaching the word's heap buffer would need a blocking load of the node.
+    constexpr std::size_t kPrefetchNodeDistance = 16;
+
+    inline void prefetch(const void* address) {
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_prefetch(address);
+#else
+        (void)address;
+#endif
+    }
+
+    std::pair<std::size_t, std::size_t> chunkRange(std::size_t size, std::size_t parts, std::size_t index) {
+        return {size * index / parts, size * (index + 1) / parts};
+    }
+
+    void appendNumber(std::string& out, std::uint64_t value) {
+        char digits[20];
+        auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        out.append(digits, result.ptr);
+    }
+
+    void appendLittleEndian(std::string& out, std::uint64_t value, int bytes) {
+        for (int i = 0; i < bytes; ++i) {
+            out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+        }
+    }
+
+    // Length of the well-formed UTF-8 sequence starting at text[i], or 0 if it is malformed.
+    // Rejects overlong forms, surrogates and code points above U+10FFFF (Unicode Table 3-7).
+    std::size_t utf8SequenceLength(const std::string& text, std::size_t i) {
+        auto byte = [&](std::size_t k) { return static_cast<unsigned char>(text[k]); };
+        unsigned char lead = byte(i);
+
+        if (lead < 0x80) {
+            return 1;
+        }
+
+        std::size_t length = 0;
+        unsigned char secondMin = 0x80;
+        unsigned char secondMax = 0xBF;
+
+        if (lead >= 0xC2 && lead <= 0xDF) {
+            length = 2;
+        } else if (lead >= 0xE0 && lead <= 0xEF) {
+            length = 3;
+            secondMin = lead == 0xE0 ? 0xA0 : 0x80;
+            secondMax = lead == 0xED ? 0x9F : 0xBF;
+        } else if (lead >= 0xF0 && lead <= 0xF4) {
+            length = 4;
+            secondMin = lead == 0xF0 ? 0x90 : 0x80;
+            secondMax = lead == 0xF4 ? 0x8F : 0xBF;
+        }
+
+        if (length == 0 || i + length > text.size() || byte(i + 1) < secondMin || byte(i + 1) > secondMax) {
+            return 0;
+        }
+
+        for (std::size_t k = 2; k < length; ++k) {
+
+            if ((byte(i + k) & 0xC0) != 0x80) {
+                return 0;
+            }
+        }
+
+        return length;
+    }
+
+    // JSON string literal; malformed UTF-8 becomes U+FFFD so the document stays valid.
+    void appendJsonString(std::string& out, const std::string& text) {
+        static const char* hexDigits = "0123456789abcdef";
+        out.push_back('"');
+
+        for (std::size_t i = 0; i < text.size(); ) {
+            unsigned char c = static_cast<unsigned char>(text[i]);
+
+            if (c >= 0x80) {
+                std::size_t length = utf8SequenceLength(text, i);
+
+                if (length == 0) {
+                    out += "\\ufffd";
+                    i++;
+                } else {
+                    out.append(text, i, length);
+                    i += length;
+                }
+
+                continue;
+            }
+
+            switch (c) {
+                case '"': out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\n': out += "\\n"; break;
+                case '\r': out += "\\r"; break;
+                case '\t': out += "\\t"; break;
+                case '\b': out += "\\b"; break;
+                case '\f': out += "\\f"; break;
+                default:
+                    if (c < 0x20) {
+                        out += "\\u00";
+                        out.push_back(hexDigits[c >> 4]);
+                        out.push_back(hexDigits[c & 0x0F]);
+                    } else {
+                        out.push_back(static_cast<char>(c));
+                    }
+            }
+
+            i++;
+        }
+
+        out.push_back('"');
+    }
+
+    void appendCsvField(std::string& out, const std::string& text) {
+        if (text.find_first_of(",\"\r\n") == std::string::npos) {
+            out += text;
+            return;
+        }
+
+        out.push_back('"');
+
+        for (char c : text) {
+
+            if (c == '"') {
+                out.push_back('"');
+            }
+
+            out.push_back(c);
+        }
+
+        out.push_back('"');
+    }
+
+    void appendTsvField(std::string& out, const std::string& text) {
+        for (char c : text) {
+
+            switch (c) {
+                case '\t': out += "\\t"; break;
+                case '\n': out += "\\n"; break;
+                case '\r': out += "\\r"; break;
+                case '\\': out += "\\\\"; break;
+                default: out.push_back(c);
+            }
+        }
+    }
+}
+
+ExportFormat ResultExporter::parseFormat(const std::string& name) {
+    if (name == "text" || name == "txt") return ExportFormat::Text;
+    if (name == "csv") return ExportFormat::Csv;
+    if (name == "tsv") return ExportFormat::Tsv;
+    if (name == "json") return ExportFormat::Json;
+    if (name == "binary" || name == "bin") return ExportFormat::Binary;
+
+    throw Exceptions::InvalidArgumentException(name, "Expected one of text, csv, tsv, json, binary.");
+}
+
+std::string ResultExporter::fileExtension(ExportFormat format) {
+    switch (format) {
+        case ExportFormat::Csv: return ".csv";
+        case ExportFormat::Tsv: return ".tsv";
+        case ExportFormat::Json: return ".json";
+        case ExportFormat::Binary: return ".bin";
+        case ExportFormat::Text: break;
+    }
+
+    return ".txt";
+}
+
+std::vector<ResultExporter::SortRecord> ResultExporter::sortByCount(
+        const std::unordered_map<std::string, std::size_t>& wordCount, std::size_t threadCount) {
+    std::vector<SortRecord> entries;
+    entries.reserve(wordCount.size());
+    std::size_t maxCount = 0;
+
+    for (const auto& entry : wordCount) {
+        entries.push_back({entry.second, &entry});
+        maxCount = std::max(maxCount, entry.second);
+    }
+
+    std::size_t size = entries.size();
+    std::size_t threads = std::clamp<std::size_t>(size / kMinRowsPerThread, 1, std::max<std::size_t>(threadCount, 1));
+    std::vector<SortRecord> scratch(size);
+    std::vector<std::array<std::size_t, kRadixBuckets>> offsets(threads);
+
+    // Stable LSD radix sort on the count, one byte per pass; digits are inverted for descending order.
+    for (int shift = 0; shift < 64 && (maxCount >> shift) != 0; shift += kRadixBits) {
+        auto bucketOf = [shift](const SortRecord& record) {
+            return kRadixBuckets - 1 - ((record.count >> shift) & (kRadixBuckets - 1));
+        };
+
+        Utils::runParallel(threads, threads, [&](std::size_t t) {
+            auto [begin, end] = chunkRange(size, threads, t);
+            offsets[t].fill(0);
+
+            for (std::size_t i = begin; i < end; ++i) {
+                offsets[t][bucketOf(entries[i])]++;
+            }
+        });
+
+        std::size_t position = 0;
+        bool singleBucket = false;
+
+        for (std::size_t bucket = 0; bucket < kRadixBuckets; ++bucket) {
+            std::size_t bucketStart = position;
+
+            for (std::size_t t = 0; t < threads; ++t) {
+                std::size_t count = offsets[t][bucket];
+                offsets[t][bucket] = position;
+                position += count;
+            }
+
+            singleBucket = singleBucket || position - bucketStart == size;
+        }
+
+        if (singleBucket) {
+            continue;
+        }
+
+        Utils::runParallel(threads, threads, [&](std::size_t t) {
+            auto [begin, end] = chunkRange(size, threads, t);
+
+            for (std::size_t i = begin; i < end; ++i) {
+                scratch[offsets[t][bucketOf(entries[i])]++] = entries[i];
+            }
+        });
+
+        entries.swap(scratch);
+    }
+
+    return entries;
+}
+
+void ResultExporter::formatRow(std::string& out, const WordEntry& entry, std::size_t rowIndex, ExportFormat format) {
+    switch (format) {
+        case ExportFormat::Csv:
+            appendCsvField(out, entry.first);
+            out.push_back(',');
+            appendNumber(out, entry.second);
+            out.push_back('\n');
+            break;
+        case ExportFormat::Tsv:
+            appendTsvField(out, entry.first);
+            out.push_back('\t');
+            appendNumber(out, entry.second);
+            out.push_back('\n');
+            break;
+        case ExportFormat::Json:
+            out += rowIndex == 0 ? "\n    {\"word\": " : ",\n    {\"word\": ";
+            appendJsonString(out, entry.first);
+            out += ", \"count\": ";
+            appendNumber(out, entry.second);
+            out.push_back('}');
+            break;
+        case ExportFormat::Binary:
+            appendLittleEndian(out, entry.first.size(), 4);
+            out += entry.first;
+            appendLittleEndian(out, entry.second, 8);
+            break;
+        case ExportFormat::Text:
+            break;
+    }
+}
+
+std::size_t ResultExporter::exportWordCounts(const std::unordered_map<std::string, std::size_t>& wordCount,
+                                             const std::string& outputFilePath, ExportFormat format,
+                                             std::size_t wordLimit, std::size_t threadCount) {
+    if (format == ExportFormat::Text) {
+        throw Exceptions::InvalidArgumentException("text", "The text report is written by WordCounter, not the exporter.");
+    }
+
+    std::ofstream outputFile(outputFilePath, std::ios::binary | std::ios::trunc);
+
+    if (!outputFile) {
+        throw Exceptions::OutputException(outputFilePath, "Unable to open output file.");
+    }
+
+    auto sorted = sortByCount(wordCount, threadCount);
+    std::size_t rows = std::min(wordLimit, sorted.size());
+    std::string header;
+
+    switch (format) {
+        case ExportFormat::Csv: header = "word,count\n"; break;
+        case ExportFormat::Tsv: header = "word\tcount\n"; break;
+        case ExportFormat::Json:
+            header = "{\n  \"uniqueWords\": ";
+            appendNumber(header, wordCount.size());
+            header += ",\n  \"words\": [";
+            break;
+        case ExportFormat::Binary:
+            header = "WCNT";
+            appendLittleEndian(header, 1, 4);
+            appendLittleEndian(header, rows, 8);
+            break;
+        case ExportFormat::Text: break;
+    }
+
+    outputFile.write(header.data(), static_cast<std::streamsize>(header.size()));
+
+    // Rows are formatted in parallel one block at a time so memory stays bounded, then written in order.
+    std::size_t threads = std::clamp<std::size_t>(rows / kMinRowsPerThread, 1, std::max<std::size_t>(threadCount, 1));
+    std::vector<std::string> buffers(threads);
+
+    for (std::size_t blockStart = 0; blockStart < rows; blockStart += threads * kRowsPerBlock) {
+        std::size_t blockRows = std::min(rows - blockStart, threads * kRowsPerBlock);
+
+        Utils::runParallel(threads, threads, [&](std::size_t t) {
+            auto [begin, end] = chunkRange(blockRows, threads, t);
+            buffers[t].clear();
+
+            for (std::size_t i = blockStart + begin; i < blockStart + end; ++i) {
+
+                if (i + kPrefetchNodeDistance < rows) {
+                    prefetch(sorted[i + kPrefetchNodeDistance].entry);
+                }
+
+                formatRow(buffers[t], *sorted[i].entry, i, format);
+            }
+        });
+
+        for (const auto& buffer : buffers) {
+            outputFile.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        }
+    }
+
+    if (format == ExportFormat::Json) {
+        const std::string footer = rows == 0 ? "]\n}\n" : "\n  ]\n}\n";
+        outputFile.write(footer.data(), static_cast<std::streamsize>(footer.size()));
+    }
+
+    outputFile.close();
+
+    if (!outputFile) {
+        throw Exceptions::OutputException(outputFilePath, "Failed writing output file.");
+    }
+
+    return rows;
+}
@@ -1,4 +1,5 @@
 #include "../include/Utils.hpp"
+#include "../include/Exceptions.hpp"
 #include <filesystem>
 #include <algorithm>
 #include <cctype>
@@ -6,6 +7,11 @@
 #include <locale>
 #include <codecvt>
 #include <fstream>
+#include <iostream>
+#include <atomic>
+#include <exception>
+#include <system_error>
+#include <thread>
 
 namespace Utils {
     bool fileExists(const std::string& filePath) {
@@ -193,4 +199,91 @@ namespace Utils {
 
         return true;
     }
-}
\ No newline at end of file
+
+    void setupUTF8Locale() {
+        try {
+            std::vector<std::string> utf8Locales = {
+                "en_US.UTF-8", "C.UTF-8", "POSIX.UTF-8", 
+                "pl_PL.UTF-8", "de_DE.UTF-8", "fr_FR.UTF-8"
+            };
+            
+            bool localeSet = false;
+            
+            for (const auto& locale : utf8Locales) {
+                
+                try {
+                    std::locale::global(std::locale(locale));
+                    std::cout.imbue(std::locale(locale));
+                    std::cerr << "Using locale: " << locale << std::endl;
+                    localeSet = true;
+                    break;
+                } catch (const std::runtime_error&) {
+                    continue; 
+                }
+            }
+            
+            if (!localeSet) {
+                std::cerr << "Warning: Could not set UTF-8 locale. International characters may not display correctly." << std::endl;
+                
+                try {
+                    std::locale::global(std::locale(""));
+                    std::cout.imbue(std::locale(""));
+                } catch (const std::runtime_error& e) {
+                    std::cerr << "Warning: Failed to set any locale. Using C locale. Error: " << e.what() << std::endl;
+                    std::locale::global(std::locale("C"));
+                    std::cout.imbue(std::locale("C"));
+                }
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Warning: Locale setup failed. Using default locale. Error: " << e.what() << std::endl;
+        }
+    }
+
+    void runParallel(std::size_t taskCount, std::size_t threadCount, const std::function<void(std::size_t)>& task) {
+        std::size_t workerCount = std::min(std::max<std::size_t>(threadCount, 1), taskCount);
+        std::atomic<std::size_t> nextTask{0};
+        std::vector<std::exception_ptr> failures(workerCount);
+
+        // A failure stops the remaining tasks and is rethrown on the calling thread after the join.
+        auto worker = [&](std::size_t workerIndex) {
+            try {
+                for (std::size_t index = nextTask++; index < taskCount; index = nextTask++) {
+                    task(index);
+                }
+            } catch (...) {
+                failures[workerIndex] = std::current_exception();
+                nextTask = taskCount;
+            }
+        };
+
+        std::vector<std::thread> workers;
+        workers.reserve(workerCount);
+
+        try {
+            for (std::size_t i = 1; i < workerCount; ++i) {
+                workers.emplace_back(worker, i);
+            }
+        } catch (const std::system_error& e) {
+            nextTask = taskCount;
+
+            for (auto& thread : workers) {
+                thread.join();
+            }
+
+            throw Exceptions::ThreadException(e.what());
+        }
+
+        worker(0);
+
+        for (auto& thread : workers) {
+            thread.join();
+        }
+
+        for (const auto& failure : failures) {
+
+            if (failure) {
+                std::rethrow_exception(failure);
+            }
+        }
+    }
+}
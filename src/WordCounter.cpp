@@ -4,125 +4,162 @@
 #include "../include/Utils.hpp"
 #include <iostream>
 #include <fstream>
-#include <future>
 #include <thread>
 #include <algorithm>
 #include <iomanip>
-#include <locale>
-#include <codecvt>
 #include <map>
+#include <atomic>
+#include <limits>
 
 WordCounter::WordCounter(std::size_t threadCount) 
     : m_threadCount(threadCount == 0 ? std::thread::hardware_concurrency() : threadCount) {
 
-    try {
-        std::vector<std::string> utf8Locales = {
-            "en_US.UTF-8", "C.UTF-8", "POSIX.UTF-8", 
-            "pl_PL.UTF-8", "de_DE.UTF-8", "fr_FR.UTF-8"
-        };
-        
-        bool localeSet = false;
-        
-        for (const auto& locale : utf8Locales) {
-            
+    Utils::setupUTF8Locale();
+
+    std::cout << "Using " << m_threadCount << " threads for word processing." << std::endl;
+}
+
+void WordCounter::processFiles(const std::vector<std::string>& filePaths) {
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    m_countOnly = false;
+    m_globalWordCount.clear();
+    m_fileStats.clear();
+
+    // Several files per task so tiny files do not each pay for a task, a table and a locked merge.
+    std::size_t workerCount = std::max<std::size_t>(m_threadCount, 1);
+    std::size_t batchSize = std::clamp<std::size_t>(filePaths.size() / (workerCount * kBatchesPerWorker), 1, kMaxBatchSize);
+    std::size_t batchCount = (filePaths.size() + batchSize - 1) / batchSize;
+
+    std::vector<WordCountStats> results(filePaths.size());
+    std::vector<char> succeeded(filePaths.size(), 0);
+
+    Utils::runParallel(batchCount, m_threadCount, [&](std::size_t batch) {
+        thread_local BatchWordCount batchWordCount;
+        thread_local std::string buffer;
+        std::string report;
+        std::string errors;
+
+        std::size_t first = batch * batchSize;
+        std::size_t last = std::min(first + batchSize, filePaths.size());
+
+        for (std::size_t index = first; index < last; ++index) {
+            const std::string& filePath = filePaths[index];
+
             try {
-                std::locale::global(std::locale(locale));
-                std::cout.imbue(std::locale(locale));
-                std::cerr << "Using locale: " << locale << std::endl;
-                localeSet = true;
-                break;
-            } catch (const std::runtime_error&) {
-                continue; 
+                results[index] = WordProcessor::processFile(filePath, batchWordCount, index + 1, buffer);
+                succeeded[index] = 1;
+            } catch (const Exceptions::FileNotFoundException&) {
+                errors += "File does not exist: " + filePath + "\n";
+                continue;
+            } catch (const Exceptions::NotRegularFileException&) {
+                errors += "Not a regular file: " + filePath + "\n";
+                continue;
+            } catch (const Exceptions::WordCounterException& e) {
+                errors += std::string("Error: ") + e.what() + "\n";
+                continue;
             }
+
+            const WordCountStats& stats = results[index];
+            report += "Processed files " + filePath
+                    + " (" + std::to_string(stats.totalWords) + " words, "
+                    + std::to_string(stats.uniqueWords) + " unique) in "
+                    + std::to_string(stats.processingTime.count()) + " ms\n";
         }
-        
-        if (!localeSet) {
-            std::cerr << "Warning: Could not set UTF-8 locale. International characters may not display correctly." << std::endl;
-            
-            try {
-                std::locale::global(std::locale(""));
-                std::cout.imbue(std::locale(""));
-            } catch (const std::runtime_error& e) {
-                std::cerr << "Warning: Failed to set any locale. Using C locale. Error: " << e.what() << std::endl;
-                std::locale::global(std::locale("C"));
-                std::cout.imbue(std::locale("C"));
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            for (const auto& [word, tally] : batchWordCount) {
+                m_globalWordCount[word] += tally.count;
             }
+
+            std::cerr << errors;
+            std::cout << report;
+        }
+
+        batchWordCount.clear();
+    });
+
+    m_fileStats.reserve(filePaths.size());
+
+    for (std::size_t i = 0; i < results.size(); ++i) {
+
+        if (succeeded[i]) {
+            m_fileStats.push_back(std::move(results[i]));
         }
-    } catch (const std::exception& e) {
-        std::cerr << "Warning: Locale setup failed. Using default locale. Error: " << e.what() << std::endl;
     }
 
-    std::cout << "Using " << m_threadCount << " threads for word processing." << std::endl;
+    auto endTime = std::chrono::high_resolution_clock::now();
+    m_totalProcessingTime = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime);
 }
 
-void WordCounter::processFiles(const std::vector<std::string>& filePaths) {
+void WordCounter::countFiles(const std::vector<std::string>& filePaths) {
     auto startTime = std::chrono::high_resolution_clock::now();
 
+    m_countOnly = true;
     m_globalWordCount.clear();
     m_fileStats.clear();
-    m_fileStats.reserve(filePaths.size());
-    
-    std::vector<std::future<WordCountStats>> futures;
-    futures.reserve(filePaths.size());
-    
-    for (const auto& filePath : filePaths) {
-   
-        if (!Utils::fileExists(filePath)) {
+
+    std::vector<WordCountStats> results(filePaths.size());
+    std::vector<char> succeeded(filePaths.size(), 0);
+
+    Utils::runParallel(filePaths.size(), m_threadCount, [&](std::size_t index) {
+        const std::string& filePath = filePaths[index];
+
+        try {
+            results[index] = WordProcessor::countFile(filePath);
+            succeeded[index] = 1;
+        } catch (const Exceptions::FileNotFoundException&) {
+            std::lock_guard<std::mutex> lock(m_mutex);
             std::cerr << "File does not exist: " << filePath << std::endl;
-            continue;
+        } catch (const Exceptions::NotRegularFileException&) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            std::cerr << "Not a regular file: " << filePath << std::endl;
+        } catch (const Exceptions::WordCounterException& e) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            std::cerr << "Error: " << e.what() << std::endl;
         }
-        
+    });
 
-        futures.push_back(std::async(std::launch::async, [this, filePath]() {
-            WordCountStats stats = WordProcessor::processFile(filePath);
-                                    std::ifstream inputFile(filePath);
-                                    std::string fileContents((std::istreambuf_iterator<char>(inputFile)), 
-                                                              std::istreambuf_iterator<char>());
-            std::unordered_map<std::string, size_t> localWordCount;
-            std::unordered_map<std::string, size_t> localLetterCount;
-            auto tokens = Utils::tokenizeText(fileContents);
-            
-            for (const auto& token : tokens) {
-                std::string cleanedWord = Utils::cleanWord(token);
-                std::string cleanedLetter = Utils::cleanWord(token);
-                
-                if (!cleanedWord.empty()) {
-                    localWordCount[cleanedWord]++;
-                }
-
-                if (!cleanedLetter.empty()) {
-                    localLetterCount[cleanedLetter]++;
-                }
-            }
-            
-            {
-                std::lock_guard<std::mutex> lock(m_mutex);
-                
-                for (const auto& [word, count] : localWordCount) {
-                    m_globalWordCount[word] += count;
-                }
+    m_fileStats.reserve(filePaths.size());
 
-            }
-            
-            std::cout << "Processed files " << filePath 
-                      << " (" << stats.totalWords << " words, "
-                      << stats.uniqueWords << " unique) in "
-                      << stats.processingTime.count() << " ms\n";
-            
-            return stats;
-        }));
-    }
-    
-    for (auto& future : futures) {
-        m_fileStats.push_back(future.get());
+    for (std::size_t i = 0; i < results.size(); ++i) {
+
+        if (succeeded[i]) {
+            m_fileStats.push_back(std::move(results[i]));
+        }
     }
-    
+
     auto endTime = std::chrono::high_resolution_clock::now();
     m_totalProcessingTime = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime);
 }
 
+void WordCounter::printCountSummary(std::ostream& out) const {
+    WordCountStats total;
+    total.totalWords = 0;
 
-void WordCounter::saveResultToFile(const std::string& outputFilePath) const {
+    for (const auto& stats : m_fileStats) {
+        out << std::setw(12) << std::right << stats.lines
+            << std::setw(12) << stats.totalWords
+            << std::setw(12) << stats.characters
+            << std::setw(14) << stats.bytes
+            << "  " << stats.fileName << "\n";
+
+        total.lines += stats.lines;
+        total.totalWords += stats.totalWords;
+        total.characters += stats.characters;
+        total.bytes += stats.bytes;
+    }
+
+    out << std::setw(12) << std::right << total.lines
+        << std::setw(12) << total.totalWords
+        << std::setw(12) << total.characters
+        << std::setw(14) << total.bytes
+        << "  total\n" << std::left;
+}
+
+void WordCounter::saveResultToFile(const std::string& outputFilePath, std::size_t wordLimit) const {
     std::ofstream outputFile(outputFilePath, std::ios::binary);
 
     if(!outputFile) {
@@ -131,6 +168,15 @@ void WordCounter::saveResultToFile(const std::string& outputFilePath) const {
 
     outputFile << static_cast<char>(0xEF) << static_cast<char>(0xBB) << static_cast<char>(0xBF);
 
+    if (m_countOnly) {
+        outputFile << "Count Summary (lines, words, characters, bytes)\n";
+        outputFile << "Total Files Processed: " << m_fileStats.size() << "\n";
+        outputFile << "Total Processing Time: " << getTotalProcessingTime().count() << " ms\n\n";
+        printCountSummary(outputFile);
+        std::cout << "Results saved to " << outputFilePath << std::endl;
+        return;
+    }
+
     outputFile << "Word Count Summary\n";
     outputFile << "Total Unique Words: " << getTotalUniqueWords() << "\n";
     outputFile << "Total Files Processed: " << m_fileStats.size() << "\n";
@@ -145,7 +191,12 @@ void WordCounter::saveResultToFile(const std::string& outputFilePath) const {
     outputFile << "Processing Time: " << stats.processingTime.count() << " ms\n\n";
     }
 
-    outputFile << "20 most frequent words\n";
+    if (wordLimit == std::numeric_limits<std::size_t>::max()) {
+        outputFile << "All words by frequency\n";
+    } else {
+        outputFile << wordLimit << " most frequent words\n";
+    }
+
     std::vector<std::pair<std::string, std::size_t>> wordFrequency(m_globalWordCount.begin(), m_globalWordCount.end());
     std::sort(wordFrequency.begin(), wordFrequency.end(),
               [](const auto& a, const auto& b) { return a.second > b.second; });
@@ -153,17 +204,48 @@ void WordCounter::saveResultToFile(const std::string& outputFilePath) const {
     std::size_t count = 0;
 
     for (const auto& [word,freq] : wordFrequency) {
-        outputFile << std::setw(20) << std::left << word << ": " << freq << "\n";
-        
-        if (++count >= 20) {
+
+        if (count++ >= wordLimit) {
             break;
         }
+
+        outputFile << std::setw(20) << std::left << word << ": " << freq << "\n";
     }
    
     std::cout << "Results saved to " << outputFilePath << std::endl;
 }
 
+void WordCounter::exportResults(const std::string& outputFilePath, ExportFormat format, std::size_t wordLimit) const {
+    if (format == ExportFormat::Text) {
+        saveResultToFile(outputFilePath, wordLimit);
+        return;
+    }
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+    std::size_t rows = ResultExporter::exportWordCounts(m_globalWordCount, outputFilePath, format, wordLimit, m_threadCount);
+    auto endTime = std::chrono::high_resolution_clock::now();
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime);
+    std::size_t rowsPerSecond = static_cast<std::size_t>(rows / std::max(std::chrono::duration<double>(endTime - startTime).count(), 1e-9));
+
+    std::cout << "Exported " << rows << " rows to " << outputFilePath << " in "
+              << elapsed.count() << " ms (" << rowsPerSecond << " rows/s)" << std::endl;
+}
+
 void WordCounter::printSummary() const {
+    if (m_countOnly) {
+        std::cout << "Count Summary\n";
+        std::cout << "===================\n";
+        std::cout << "Total Files Processed: " << m_fileStats.size() << "\n";
+        std::cout << "Total Processing Time: " << getTotalProcessingTime().count() << " ms\n\n";
+        std::cout << std::setw(12) << std::right << "lines"
+                  << std::setw(12) << "words"
+                  << std::setw(12) << "chars"
+                  << std::setw(14) << "bytes" << "  file\n" << std::left;
+        printCountSummary(std::cout);
+        return;
+    }
+
     std::cout << "Word Count Summary\n";
     std::cout << "===================\n";
     std::cout << "Total Unique Words: " << getTotalUniqueWords() << "\n";
@@ -202,4 +284,12 @@ std::size_t WordCounter::getTotalUniqueWords() const {
 
 std::chrono::milliseconds WordCounter::getTotalProcessingTime() const {
     return m_totalProcessingTime;
+}
+
+const std::unordered_map<std::string, std::size_t>& WordCounter::getWordCounts() const {
+    return m_globalWordCount;
+}
+
+const std::vector<WordCountStats>& WordCounter::getFileStats() const {
+    return m_fileStats;
 }
\ No newline at end of file
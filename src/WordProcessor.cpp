@@ -2,83 +2,256 @@
 #include "../include/Exceptions.hpp"
 #include "../include/Utils.hpp"
 #include <fstream>
-#include <sstream>
+#include <algorithm>
 #include <iostream>
 #include <chrono>
+#include <cstdint>
+#include <vector>
+#include <filesystem>
+#include <system_error>
+
+namespace {
+    constexpr std::size_t kCountBufferSize = 1 << 20;
+    constexpr std::size_t kReadChunkSize = 1 << 16;
+
+    constexpr std::uint64_t kOnes = 0x0101010101010101ULL;
+    constexpr std::uint64_t kLow7 = 0x7F7F7F7F7F7F7F7FULL;
+    constexpr std::uint64_t kHigh = 0x8080808080808080ULL;
+
+    // Assembles the bytes in memory order so byte i always lands in bits [8i, 8i + 8).
+    inline std::uint64_t loadWord(const unsigned char* p) {
+        std::uint64_t word = 0;
+
+        for (int i = 0; i < 8; ++i) {
+            word |= static_cast<std::uint64_t>(p[i]) << (8 * i);
+        }
+
+        return word;
+    }
+
+    // 0x80 in every byte that is zero, 0x00 elsewhere (exact, no false positives).
+    inline std::uint64_t zeroBytes(std::uint64_t v) {
+        return ~(((v & kLow7) + kLow7) | v | kLow7);
+    }
+
+    inline std::uint64_t equalBytes(std::uint64_t v, unsigned char c) {
+        return zeroBytes(v ^ (kOnes * c));
+    }
+
+    // ASCII whitespace as understood by std::isspace in the C locale: ' ' and '\t'..'\r'.
+    inline std::uint64_t spaceBytes(std::uint64_t v) {
+        std::uint64_t low = v & kLow7;
+        std::uint64_t atLeastTab = (low + kOnes * (0x80 - '\t')) & kHigh;
+        std::uint64_t pastReturn = (low + kOnes * (0x80 - '\r' - 1)) & kHigh;
+
+        return (atLeastTab & ~pastReturn & ~v & kHigh) | equalBytes(v, ' ');
+    }
+
+    // Bytes of the form 10xxxxxx, i.e. UTF-8 continuation bytes.
+    inline std::uint64_t continuationBytes(std::uint64_t v) {
+        return v & ~(v << 1) & kHigh;
+    }
+
+    inline std::size_t countMarked(std::uint64_t mask) {
+        return static_cast<std::size_t>(((mask >> 7) * kOnes) >> 56);
+    }
+
+    // Only reached once a read has failed, so the fast path never pays for the extra stat.
+    [[noreturn]] void throwReadFailure(const std::string& filePath) {
+        std::error_code error;
+
+        if (!std::filesystem::is_regular_file(filePath, error)) {
+            throw Exceptions::NotRegularFileException(filePath);
+        }
+
+        throw Exceptions::FileProcessingException(filePath, "Read failed.");
+    }
+
+    inline bool isAsciiSpace(unsigned char c) {
+        return c == ' ' || (c >= '\t' && c <= '\r');
+    }
+}
 
 WordCountStats WordProcessor::processFile(const std::string& filePath) {
+    BatchWordCount wordCount;
+    std::string buffer;
+
+    return processFile(filePath, wordCount, 1, buffer);
+}
+
+WordCountStats WordProcessor::processFile(const std::string& filePath, BatchWordCount& batchCount,
+                                          std::size_t fileTag, std::string& buffer) {
     WordCountStats stats;
     stats.fileName = filePath;
+    stats.totalWords = 0;
+    stats.uniqueWords = 0;
+
+    auto startTime = std::chrono::high_resolution_clock::now();
 
-    auto startTIme = std::chrono::high_resolution_clock::now();
+    readFileContents(filePath, buffer);
 
     try {
-        std::string fileContents = readFileContents(filePath);
-        auto wordCount = countWords(fileContents);
-        stats.uniqueWords = wordCount.size();
-
-        stats.totalWords=0;
-        
-        for (const auto& [word, count] : wordCount)  {
-            stats.totalWords += count;
-        }
+        auto tokens = Utils::tokenizeText(buffer);
+
+        for (const auto& token : tokens) {
+            std::string cleanedWord = Utils::cleanWord(token);
+
+            if (cleanedWord.empty()) {
+                continue;
+            }
 
-    
+            WordTally& tally = batchCount[std::move(cleanedWord)];
+            tally.count++;
+            stats.totalWords++;
+
+            if (tally.lastFile != fileTag) {
+                tally.lastFile = fileTag;
+                stats.uniqueWords++;
+            }
+        }
     } catch (const std::exception& e) {
         throw Exceptions::FileProcessingException(filePath, e.what());
     }
 
+    stats.bytes = buffer.size();
+
     auto endTime = std::chrono::high_resolution_clock::now();
-    stats.processingTime = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTIme);
+    stats.processingTime = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime);
 
     return stats;
 }
 
-std::string WordProcessor::readFileContents(const std::string& filePath) {
-    bool isUTF8 = Utils::isUTF8File(filePath);
-    
+std::size_t WordProcessor::countWords(const std::string& text, std::unordered_map<std::string, std::size_t>& wordCount) {
+    std::size_t totalWords = 0;
+    auto tokens = Utils::tokenizeText(text);
+
+    for (const auto& token : tokens) {
+        std::string cleanedWord = Utils::cleanWord(token);
+
+        if (!cleanedWord.empty()) {
+            wordCount[std::move(cleanedWord)]++;
+            totalWords++;
+        }
+    }
+
+    return totalWords;
+}
+
+void WordProcessor::readFileContents(const std::string& filePath, std::string& buffer) {
     std::ifstream file(filePath, std::ios::binary);
-    
+
     if (!file) {
         throw Exceptions::FileNotFoundException(filePath);
     }
 
-    std::string content;
-    
-    if (isUTF8) {
-        char bom[3];
-        file.read(bom, 3);
-        
-        if (file.gcount() == 3 && 
-            static_cast<unsigned char>(bom[0]) == 0xEF &&
-            static_cast<unsigned char>(bom[1]) == 0xBB &&
-            static_cast<unsigned char>(bom[2]) == 0xBF) {
+    buffer.clear();
+    std::size_t chunkSize = kReadChunkSize;
 
-        } else {
+    while (true) {
+        std::size_t used = buffer.size();
+        buffer.resize(used + chunkSize);
+        file.read(&buffer[used], static_cast<std::streamsize>(chunkSize));
+        buffer.resize(used + static_cast<std::size_t>(file.gcount()));
 
-            file.seekg(0);
+        if (!file) {
+            break;
         }
+
+        chunkSize = std::min(chunkSize * 2, kCountBufferSize * 16);
     }
 
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    content = buffer.str();
+    if (file.bad()) {
+        throwReadFailure(filePath);
+    }
 
-    return content;
+    if (buffer.size() >= 3 &&
+        static_cast<unsigned char>(buffer[0]) == 0xEF &&
+        static_cast<unsigned char>(buffer[1]) == 0xBB &&
+        static_cast<unsigned char>(buffer[2]) == 0xBF) {
+        buffer.erase(0, 3);
+    }
 }
 
-std::unordered_map<std::string, std::size_t> WordProcessor::countWords(const std::string& text) {
-    std::unordered_map<std::string, std::size_t> wordCount;
-    auto tokens = Utils::tokenizeText(text);
+WordCountStats WordProcessor::countFile(const std::string& filePath) {
+    WordCountStats stats;
+    stats.fileName = filePath;
+    stats.totalWords = 0;
+    stats.uniqueWords = 0;
 
-    for (const auto& token : tokens) {
-        std::string cleanedWord = Utils::cleanWord(token);
-        
-        if (!cleanedWord.empty()) {
-            wordCount[cleanedWord]++;
-        } 
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    std::ifstream file(filePath, std::ios::binary);
+
+    if (!file) {
+        throw Exceptions::FileNotFoundException(filePath);
+    }
+
+    thread_local std::vector<char> buffer(kCountBufferSize);
+    bool previousIsSpace = true;
+
+    while (file) {
+        file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        std::streamsize bytesRead = file.gcount();
+
+        if (bytesRead <= 0) {
+            break;
+        }
+
+        scanBuffer(buffer.data(), static_cast<std::size_t>(bytesRead), stats, previousIsSpace);
+    }
+
+    if (file.bad()) {
+        throwReadFailure(filePath);
     }
 
-    return wordCount;
+    auto endTime = std::chrono::high_resolution_clock::now();
+    stats.processingTime = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime);
+
+    return stats;
 }
 
+void WordProcessor::scanBuffer(const char* data, std::size_t size, WordCountStats& stats, bool& previousIsSpace) {
+    const auto* bytes = reinterpret_cast<const unsigned char*>(data);
+    std::size_t lines = 0;
+    std::size_t words = 0;
+    std::size_t continuations = 0;
+    std::uint64_t carry = previousIsSpace ? 0x80 : 0;
+    std::size_t i = 0;
+
+    for (; i + 8 <= size; i += 8) {
+        std::uint64_t word = loadWord(bytes + i);
+        std::uint64_t spaces = spaceBytes(word);
+        std::uint64_t wordStarts = ~spaces & kHigh & ((spaces << 8) | carry);
+
+        lines += countMarked(equalBytes(word, '\n'));
+        words += countMarked(wordStarts);
+        continuations += countMarked(continuationBytes(word));
+        carry = spaces >> 56;
+    }
+
+    previousIsSpace = carry != 0;
+
+    for (; i < size; ++i) {
+        unsigned char c = bytes[i];
+        bool isSpace = isAsciiSpace(c);
+
+        if (c == '\n') {
+            lines++;
+        }
+
+        if (!isSpace && previousIsSpace) {
+            words++;
+        }
+
+        if ((c & 0xC0) == 0x80) {
+            continuations++;
+        }
+
+        previousIsSpace = isSpace;
+    }
+
+    stats.lines += lines;
+    stats.totalWords += words;
+    stats.bytes += size;
+    stats.characters += size - continuations;
+}
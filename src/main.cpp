@@ -1,8 +1,17 @@
 #include <iostream>
 #include <vector>
+#include <unordered_set>
 #include <string>
 #include <locale>
+#include <atomic>
+#include <csignal>
+#include <algorithm>
+#include <chrono>
+#include <limits>
 #include "../include/WordCounter.hpp"
+#include "../include/FileFollower.hpp"
+#include "../include/QueryServer.hpp"
+#include "../include/ResultExporter.hpp"
 #include "../include/Utils.hpp"
 #include "../include/Exceptions.hpp"
 
@@ -10,6 +19,12 @@
 #include <windows.h>
 #endif
 
+std::atomic<bool> g_stopRequested{false};
+
+void requestStop(int) {
+    g_stopRequested = true;
+}
+
 void setupConsoleForUnicode() {
 #ifdef _WIN32
     // Simple UTF-8 setup for Windows console
@@ -23,9 +38,134 @@ void showUsage(const std::string& programName) {
     std::cout << "Options:" << std::endl;
     std::cout << "  -h, --help       Show this help message" << std::endl;
     std::cout << "  -t, --threads    Number of threads to use (default: auto-detect)" << std::endl;
+    std::cout << "  -c, --count-only Only count lines, words, characters and bytes (wc-style)" << std::endl;
+    std::cout << "  -f, --follow     Follow files or directories and count appended text until interrupted" << std::endl;
+    std::cout << "  --interval       Seconds between summaries and checkpoints in follow mode (default: 5)" << std::endl;
+    std::cout << "  --checkpoint     Checkpoint file for follow mode (default: wordCounter.checkpoint)" << std::endl;
+    std::cout << "  --format         Output format: text, csv, tsv, json or binary (default: text)" << std::endl;
+    std::cout << "  --all            Export the full vocabulary instead of the 20 most frequent words" << std::endl;
+    std::cout << "  -o, --output     Output file (skips the prompt)" << std::endl;
     std::cout << "Example:" << std::endl;
     std::cout << "  " << programName << " file1.txt file2.txt" << std::endl;
     std::cout << "  " << programName << " -t 4 file1.txt file2.txt" << std::endl;
+    std::cout << "  " << programName << " --count-only -t 8 *.log" << std::endl;
+    std::cout << "  " << programName << " --format csv --all -o vocabulary.csv *.txt" << std::endl;
+    std::cout << "  " << programName << " --follow --interval 10 /var/log/app" << std::endl;
+    std::cout << "Server mode:" << std::endl;
+    std::cout << "  " << programName << " serve [--socket PATH] [-t N] [file1 ... fileN]" << std::endl;
+    std::cout << "  " << programName << " loadtest [--socket PATH | --ingest FILE] [-c CONNECTIONS] [-n REQUESTS]" << std::endl;
+}
+
+bool parseCount(int argc, char* argv[], int& i, std::size_t& value) {
+    if (i + 1 >= argc) {
+        std::cerr << "Error: " << argv[i] << " option requires a number." << std::endl;
+        return false;
+    }
+
+    try {
+        value = std::stoul(argv[++i]);
+    } catch (const std::exception&) {
+        std::cerr << "Error: Invalid " << argv[i - 1] << " argument." << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+int runServe(int argc, char* argv[]) {
+    ServeOptions options;
+    std::vector<std::string> filePaths;
+    std::unordered_set<std::string> seenPaths;
+    std::size_t threadCount = 0;
+
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+
+        if (arg == "--socket") {
+            if (i + 1 < argc) {
+                options.socketPath = argv[++i];
+            } else {
+                std::cerr << "Error: --socket option requires a socket path." << std::endl;
+                return 1;
+            }
+        } else if (arg == "-t" || arg == "--threads") {
+            if (!parseCount(argc, argv, i, threadCount)) {
+                return 1;
+            }
+        } else if (seenPaths.insert(arg).second) {
+            filePaths.push_back(arg);
+        }
+    }
+
+    QueryServer server(options);
+
+    // Scoped so the counter's copy of the vocabulary is freed before serving starts
+    {
+        // Constructing the counter also sets up the UTF-8 locale word cleaning relies on
+        WordCounter counter(threadCount);
+
+        if (!filePaths.empty()) {
+            counter.processFiles(filePaths);
+            server.ingest(counter.getWordCounts(), counter.getFileStats());
+        }
+    }
+
+    std::signal(SIGINT, requestStop);
+    std::signal(SIGTERM, requestStop);
+#ifdef SIGPIPE
+    std::signal(SIGPIPE, SIG_IGN);
+#endif
+
+    server.run(g_stopRequested);
+    return 0;
+}
+
+int runLoadTest(int argc, char* argv[]) {
+    std::string socketPath = ServeOptions().socketPath;
+    std::size_t connections = 4;
+    std::size_t requests = 10000;
+    std::string ingestPath;
+    bool socketGiven = false;
+
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+
+        if (arg == "--socket") {
+            if (i + 1 < argc) {
+                socketPath = argv[++i];
+                socketGiven = true;
+            } else {
+                std::cerr << "Error: --socket option requires a socket path." << std::endl;
+                return 1;
+            }
+        } else if (arg == "-c" || arg == "--connections") {
+            if (!parseCount(argc, argv, i, connections)) {
+                return 1;
+            }
+        } else if (arg == "--ingest") {
+            if (i + 1 < argc) {
+                ingestPath = argv[++i];
+            } else {
+                std::cerr << "Error: --ingest option requires a file path." << std::endl;
+                return 1;
+            }
+        } else if (arg == "-n" || arg == "--requests") {
+            if (!parseCount(argc, argv, i, requests)) {
+                return 1;
+            }
+        } else {
+            std::cerr << "Error: Unknown loadtest option " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    if (socketGiven && !ingestPath.empty()) {
+        std::cerr << "Error: --ingest runs against a scratch server and cannot be combined with --socket." << std::endl;
+        return 1;
+    }
+
+    QueryServer::runLoadTest(socketPath, connections, requests, ingestPath);
+    return 0;
 }
 
 int main(int argc, char* argv[]) {
@@ -33,8 +173,22 @@ int main(int argc, char* argv[]) {
         // Setup console for Unicode support
         setupConsoleForUnicode();
         
+        if (argc > 1 && std::string(argv[1]) == "serve") {
+            return runServe(argc, argv);
+        }
+
+        if (argc > 1 && std::string(argv[1]) == "loadtest") {
+            return runLoadTest(argc, argv);
+        }
+
         std::vector<std::string> filePaths;
         std::size_t threadCount = 0; 
+        bool countOnly = false;
+        ExportFormat exportFormat = ExportFormat::Text;
+        std::size_t wordLimit = 20;
+        std::string outputFile;
+        bool follow = false;
+        FollowOptions followOptions;
 
         // Parse command line arguments
         for (int i = 1; i < argc; ++i) {
@@ -55,11 +209,72 @@ int main(int argc, char* argv[]) {
                     std::cerr << "Error: -t option requires a number." << std::endl;
                     return 1;
                 }
+            } else if (arg == "-c" || arg == "--count-only") {
+                countOnly = true;
+            } else if (arg == "--format") {
+                if (i + 1 < argc) {
+                    exportFormat = ResultExporter::parseFormat(argv[++i]);
+                } else {
+                    std::cerr << "Error: --format option requires a format name." << std::endl;
+                    return 1;
+                }
+            } else if (arg == "--all") {
+                wordLimit = std::numeric_limits<std::size_t>::max();
+            } else if (arg == "-o" || arg == "--output") {
+                if (i + 1 < argc) {
+                    outputFile = argv[++i];
+                } else {
+                    std::cerr << "Error: -o option requires a file path." << std::endl;
+                    return 1;
+                }
+            } else if (arg == "-f" || arg == "--follow") {
+                follow = true;
+            } else if (arg == "--interval") {
+                if (i + 1 < argc) {
+                    try {
+                        followOptions.summaryInterval = std::chrono::seconds(std::max(1ul, std::stoul(argv[++i])));
+                    } catch (const std::invalid_argument&) {
+                        std::cerr << "Error: Invalid interval argument." << std::endl;
+                        return 1;
+                    }
+                } else {
+                    std::cerr << "Error: --interval option requires a number of seconds." << std::endl;
+                    return 1;
+                }
+            } else if (arg == "--checkpoint") {
+                if (i + 1 < argc) {
+                    followOptions.checkpointPath = argv[++i];
+                } else {
+                    std::cerr << "Error: --checkpoint option requires a file path." << std::endl;
+                    return 1;
+                }
             } else {
                 filePaths.push_back(arg);
             }        
         }
 
+        if (countOnly && exportFormat != ExportFormat::Text) {
+            std::cerr << "Error: --format is only available for word frequency results, not with --count-only." << std::endl;
+            return 1;
+        }
+
+        // Follow mode runs until interrupted and never prompts
+        if (follow) {
+            if (filePaths.empty()) {
+                std::cerr << "Error: --follow requires at least one file or directory." << std::endl;
+                return 1;
+            }
+
+            Utils::setupUTF8Locale();
+            std::signal(SIGINT, requestStop);
+            std::signal(SIGTERM, requestStop);
+
+            FileFollower follower(filePaths, followOptions);
+            follower.run(g_stopRequested);
+            follower.printSummary();
+            return 0;
+        }
+
         // Interactive file input if no files provided
         if (filePaths.empty()) {
             std::cout << "Provide a path for files (empty line to finish):" << std::endl;
@@ -108,18 +323,26 @@ int main(int argc, char* argv[]) {
         // Process files
         std::cout << "Processing " << filePaths.size() << " files..." << std::endl;
         WordCounter counter(threadCount);
-        counter.processFiles(filePaths);
+
+        if (countOnly) {
+            counter.countFiles(filePaths);
+        } else {
+            counter.processFiles(filePaths);
+        }
+
         counter.printSummary();
 
         // Get output file name
-        std::string outputFile = "wordCountSummary.txt";
-        std::cout << "Provide output file name (default: " << outputFile << "): ";
-        std::string userOutput;
-        if (std::getline(std::cin, userOutput) && !userOutput.empty()) {
-            outputFile = userOutput;
+        if (outputFile.empty()) {
+            outputFile = "wordCountSummary" + ResultExporter::fileExtension(exportFormat);
+            std::cout << "Provide output file name (default: " << outputFile << "): ";
+            std::string userOutput;
+            if (std::getline(std::cin, userOutput) && !userOutput.empty()) {
+                outputFile = userOutput;
+            }
         }
 
-        counter.saveResultToFile(outputFile);
+        counter.exportResults(outputFile, exportFormat, wordLimit);
         
     } catch (const Exceptions::WordCounterException& e) {
         std::cerr << "Error: " << e.what() << std::endl;